@@ -34,6 +34,7 @@
 #include <cassert>
 #include <cstdio>
 #include <cstring>
+#include <iterator>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -65,14 +66,43 @@ class FunctionFactory {
   static FunctionPtr retrieve(const std::string& _type) {
     FunctionMap& function_map = get();
     // Retrieves the function.
-    if (function_map.count(_type) > 0) {
-      return function_map.at(_type);
+    auto it = function_map.find(_type);
+    if (it != function_map.end()) {
+      return it->second;
     } else {
       // For missing type, return nullptr.
       return nullptr;
     }
   }
 
+  // This function resolves a container of function names. The result has one
+  // entry per name in the same order. Names may be any type convertible to
+  // 'const std::string&'; std::string and
+  // std::reference_wrapper<const std::string> are used without copying.
+  // Unknown names yield nullptr and, if '_missing' is given, are appended to
+  // it. This does one lookup per name, the same as calling retrieve() in a
+  // loop.
+  template <class Names>
+  static std::vector<FunctionPtr> resolveMany(
+      const Names& _types, std::vector<std::string>* _missing = nullptr) {
+    FunctionMap& function_map = get();
+    std::vector<FunctionPtr> functions;
+    functions.reserve(std::size(_types));
+    for (const auto& name : _types) {
+      const std::string& type = name;
+      auto it = function_map.find(type);
+      if (it != function_map.end()) {
+        functions.push_back(it->second);
+      } else {
+        functions.push_back(nullptr);
+        if (_missing != nullptr) {
+          _missing->push_back(type);
+        }
+      }
+    }
+    return functions;
+  }
+
   // This function returns all registered function names
   static std::vector<std::string> functions() {
     FunctionMap& function_map = get();
@@ -34,6 +34,7 @@
 #include <cassert>
 #include <cstdio>
 #include <cstring>
+#include <iterator>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -66,15 +67,43 @@ class ObjectFactory {
   static BaseClass* create(const std::string& _type, Args... _args) {
     ConstructorMap& constructor_map = get();
     // Retrieves the creator function.
-    if (constructor_map.count(_type) > 0) {
+    auto it = constructor_map.find(_type);
+    if (it != constructor_map.end()) {
       // Uses the creator function to call the constructor.
-      return constructor_map.at(_type)(_args...);
+      return it->second(_args...);
     } else {
       // For missing type, return nullptr.
       return nullptr;
     }
   }
 
+  // This function resolves a container of class names to their constructors.
+  // The result has one entry per name in the same order. Names may be any type
+  // convertible to 'const std::string&'; std::string and
+  // std::reference_wrapper<const std::string> are used without copying.
+  // Unknown names yield nullptr and, if '_missing' is given, are appended to
+  // it. This does one lookup per name, the same as calling create() in a loop.
+  template <class Names>
+  static std::vector<Constructor> resolveMany(
+      const Names& _types, std::vector<std::string>* _missing = nullptr) {
+    ConstructorMap& constructor_map = get();
+    std::vector<Constructor> constructors;
+    constructors.reserve(std::size(_types));
+    for (const auto& name : _types) {
+      const std::string& type = name;
+      auto it = constructor_map.find(type);
+      if (it != constructor_map.end()) {
+        constructors.push_back(it->second);
+      } else {
+        constructors.push_back(nullptr);
+        if (_missing != nullptr) {
+          _missing->push_back(type);
+        }
+      }
+    }
+    return constructors;
+  }
+
   // This function returns all registered class names.
   static std::vector<std::string> classes() {
     ConstructorMap& constructor_map = get();
@@ -0,0 +1,229 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FACTORY_TYPESLAB_H_
+#define FACTORY_TYPESLAB_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace factory {
+
+template <class Type>
+class SlabAllocated;
+
+// This class holds all objects of a single type in type-segregated slabs so
+// that iterating every object of that type walks contiguous memory. Slots
+// freed by deletion are reused before new slabs are allocated. Slabs are never
+// released, not even when empty, so memory is not returned to the OS.
+//
+// allocate(), deallocate(), and size() are thread safe. forEach() is not
+// synchronized, so objects of the type must not be created or deleted on other
+// threads while it runs.
+template <class Type>
+class TypeSlab {
+ public:
+  // This is the number of objects stored in each slab.
+  static constexpr std::size_t kSlabObjects =
+      sizeof(Type) >= 65536 ? 1 : 65536 / sizeof(Type);
+
+  // This function returns storage for one object of the type.
+  static void* allocate() {
+    TypeSlab& type_slab = get();
+    std::lock_guard<std::mutex> lock(type_slab.mutex_);
+    if (type_slab.free_.empty()) {
+      type_slab.grow();
+    }
+    std::size_t index = type_slab.free_.back();
+    type_slab.free_.pop_back();
+    type_slab.live_.at(index) = 1;
+    return type_slab.slot(index);
+  }
+
+  // This function returns storage previously given by allocate().
+  static void deallocate(void* _ptr) {
+    TypeSlab& type_slab = get();
+    std::lock_guard<std::mutex> lock(type_slab.mutex_);
+    std::size_t index = type_slab.index(_ptr);
+    assert(type_slab.live_.at(index) == 1);
+    type_slab.live_.at(index) = 0;
+    type_slab.free_.push_back(index);
+  }
+
+  // This function calls '_func' on every live object in memory order. Slabs
+  // are walked by address, not by creation order. '_func' may create and delete
+  // objects of the type; objects it creates may or may not be visited.
+  template <class Func>
+  static void forEach(Func _func) {
+    static_assert(std::is_base_of<SlabAllocated<Type>, Type>::value,
+                  "Type must inherit SlabAllocated<Type>");
+    TypeSlab& type_slab = get();
+    // Map iterators stay valid when '_func' causes a new slab to be added.
+    for (auto it = type_slab.bases_.cbegin(); it != type_slab.bases_.cend();
+         ++it) {
+      for (std::size_t offset = 0; offset < kSlabObjects; ++offset) {
+        if (type_slab.live_[it->second + offset] != 0) {
+          _func(*std::launder(reinterpret_cast<Type*>(&it->first[offset])));
+        }
+      }
+    }
+  }
+
+  // This function returns the number of live objects.
+  static std::size_t size() {
+    TypeSlab& type_slab = get();
+    std::lock_guard<std::mutex> lock(type_slab.mutex_);
+    return type_slab.live_.size() - type_slab.free_.size();
+  }
+
+ private:
+  typedef typename std::aligned_storage<sizeof(Type), alignof(Type)>::type Slot;
+
+  TypeSlab() = default;
+  ~TypeSlab() = delete;
+  TypeSlab(const TypeSlab&) = delete;
+  TypeSlab& operator=(const TypeSlab&) = delete;
+
+  static TypeSlab& get() {
+    // This is the slab set for this type. It is never destroyed so that
+    // objects deleted during static destruction still have valid storage.
+    static TypeSlab* type_slab = new TypeSlab();
+    return *type_slab;
+  }
+
+  // This function adds a slab and pushes its slots onto the free list such
+  // that the lowest addresses are handed out first.
+  void grow() {
+    std::size_t base = live_.size();
+    slabs_.push_back(new Slot[kSlabObjects]);
+    bases_[slabs_.back()] = base;
+    live_.resize(base + kSlabObjects, 0);
+    free_.reserve(free_.size() + kSlabObjects);
+    for (std::size_t offset = kSlabObjects; offset > 0; --offset) {
+      free_.push_back(base + offset - 1);
+    }
+  }
+
+  void* slot(std::size_t _index) {
+    return &slabs_[_index / kSlabObjects][_index % kSlabObjects];
+  }
+
+  std::size_t index(void* _ptr) {
+    Slot* ptr = static_cast<Slot*>(_ptr);
+    // Finds the slab with the greatest base address not above the pointer.
+    auto it = bases_.upper_bound(ptr);
+    assert(it != bases_.begin());
+    --it;
+    assert(ptr < it->first + kSlabObjects);
+    return it->second + static_cast<std::size_t>(ptr - it->first);
+  }
+
+  std::mutex mutex_;
+  std::vector<Slot*> slabs_;
+  std::map<Slot*, std::size_t> bases_;
+  std::vector<std::uint8_t> live_;
+  std::vector<std::size_t> free_;
+};
+
+// Derived classes inherit from this class to opt into type-segregated slab
+// placement. Objects are still created and deleted normally (e.g., via
+// ObjectFactory::create() and delete) but are placed in TypeSlab<Type>.
+//
+// The allocation functions only see the object's size and alignment, not its
+// type. A class further derived from 'Type' with the same size and no
+// stricter alignment therefore shares the slab and is visited by
+// TypeSlab<Type>::forEach() as a 'Type'. This requires the 'Type' base to be
+// at offset zero of such a subclass, as it is with single inheritance. Other
+// subclasses use the general heap. A subclass gets its own slab by also
+// inheriting SlabAllocated<Subclass> and adding using-declarations for
+// SlabAllocated<Subclass>::operator new and operator delete, which resolves
+// the otherwise ambiguous lookup.
+//
+// Placement new is passed through; other forms (e.g., nothrow) are hidden.
+template <class Type>
+class SlabAllocated {
+ public:
+  static void* operator new(std::size_t _size) {
+    if (_size != sizeof(Type)) {
+      return ::operator new(_size);
+    }
+    return TypeSlab<Type>::allocate();
+  }
+
+  static void operator delete(void* _ptr, std::size_t _size) {
+    if (_ptr == nullptr) {
+      return;
+    }
+    if (_size != sizeof(Type)) {
+      ::operator delete(_ptr);
+      return;
+    }
+    TypeSlab<Type>::deallocate(_ptr);
+  }
+
+  static void* operator new(std::size_t _size, std::align_val_t _align) {
+    if (!inSlab(_size, _align)) {
+      return ::operator new(_size, _align);
+    }
+    return TypeSlab<Type>::allocate();
+  }
+
+  static void operator delete(void* _ptr, std::size_t _size,
+                              std::align_val_t _align) {
+    if (_ptr == nullptr) {
+      return;
+    }
+    if (!inSlab(_size, _align)) {
+      ::operator delete(_ptr, _align);
+      return;
+    }
+    TypeSlab<Type>::deallocate(_ptr);
+  }
+
+  static void* operator new(std::size_t, void* _ptr) noexcept { return _ptr; }
+
+  static void operator delete(void*, void*) noexcept {}
+
+ private:
+  static bool inSlab(std::size_t _size, std::align_val_t _align) {
+    return _size == sizeof(Type) &&
+           static_cast<std::size_t>(_align) <= alignof(Type);
+  }
+};
+
+}  // namespace factory
+
+#endif  // FACTORY_TYPESLAB_H_
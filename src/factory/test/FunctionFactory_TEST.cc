@@ -30,6 +30,7 @@
  */
 #include "factory/FunctionFactory.h"
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -51,3 +52,27 @@ TEST(FunctionFactory, basic) {
   dummy_func = dummyFuncRetrieve("no_dummy");
   ASSERT_EQ(dummy_func, nullptr);
 }
+
+TEST(FunctionFactory, resolveMany) {
+  std::vector<std::string> names = {"no_dummy", "big_dummy"};
+  std::vector<std::string> missing;
+  std::vector<DummyFunc> dummy_funcs =
+      factory::FunctionFactory<DUMMYFUNC_RET, DUMMYFUNC_ARGS>::resolveMany(
+          names, &missing);
+  ASSERT_EQ(dummy_funcs.size(), 2u);
+  ASSERT_EQ(dummy_funcs.at(0), nullptr);
+  ASSERT_NE(dummy_funcs.at(1), nullptr);
+  ASSERT_EQ(dummy_funcs.at(1)(3.0, '3'), static_cast<int>(3.0 * '3'));
+  ASSERT_EQ(missing.size(), 1u);
+  ASSERT_EQ(missing.at(0), "no_dummy");
+
+  // Names held elsewhere can be passed by reference without copying.
+  std::vector<std::reference_wrapper<const std::string>> refs(names.cbegin(),
+                                                               names.cend());
+  dummy_funcs =
+      factory::FunctionFactory<DUMMYFUNC_RET, DUMMYFUNC_ARGS>::resolveMany(
+          refs);
+  ASSERT_EQ(dummy_funcs.size(), 2u);
+  ASSERT_EQ(dummy_funcs.at(0), nullptr);
+  ASSERT_NE(dummy_funcs.at(1), nullptr);
+}
@@ -53,3 +53,30 @@ TEST(ObjectFactory, basic) {
   dummy_object = DummyObject::create("no_dummy", 8, 9.0, 'z');
   ASSERT_EQ(dummy_object, nullptr);
 }
+
+TEST(ObjectFactory, resolveMany) {
+  std::vector<std::string> types = {"big_dummy", "no_dummy", "big_dummy",
+                                    "other_dummy"};
+  std::vector<std::string> missing;
+  typedef factory::ObjectFactory<DummyObject, DUMMYOBJECT_ARGS> DummyFactory;
+  std::vector<DummyFactory::Constructor> constructors =
+      DummyFactory::resolveMany(types, &missing);
+  ASSERT_EQ(constructors.size(), 4u);
+  ASSERT_NE(constructors.at(0), nullptr);
+  ASSERT_EQ(constructors.at(1), nullptr);
+  ASSERT_EQ(constructors.at(2), constructors.at(0));
+  ASSERT_EQ(constructors.at(3), nullptr);
+  ASSERT_EQ(missing.size(), 2u);
+  ASSERT_EQ(missing.at(0), "no_dummy");
+  ASSERT_EQ(missing.at(1), "other_dummy");
+
+  const char* c_types[] = {"no_dummy", "big_dummy"};
+  constructors = DummyFactory::resolveMany(c_types);
+  ASSERT_EQ(constructors.size(), 2u);
+  ASSERT_EQ(constructors.at(0), nullptr);
+  ASSERT_NE(constructors.at(1), nullptr);
+
+  DummyObject* dummy_object = constructors.at(1)(8, 9.0, 'z');
+  ASSERT_EQ(std::string(dummy_object->name()), "big_dummy");
+  delete dummy_object;
+}
@@ -0,0 +1,260 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * - Neither the name of prim nor the names of its contributors may be used to
+ * endorse or promote products derived from this software without specific prior
+ * written permission.
+ *
+ * See the NOTICE file distributed with this work for additional information
+ * regarding copyright ownership.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "factory/TypeSlab.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "factory/ObjectFactory.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+class SlabBase {
+ public:
+  virtual ~SlabBase() {}
+  virtual int value() const = 0;
+};
+
+// Each test uses its own 'kId' so that tests do not share a slab and can run
+// in any order.
+template <int kId>
+class SlabDerived : public SlabBase,
+                    public factory::SlabAllocated<SlabDerived<kId>> {
+ public:
+  explicit SlabDerived(int _value) : value_(_value) {}
+  int value() const override { return value_; }
+
+ private:
+  int value_;
+};
+
+typedef SlabDerived<0> FactoryDerived;
+typedef SlabDerived<1> SubclassDerived;
+typedef SlabDerived<2> PlacementDerived;
+typedef SlabDerived<3> ThreadDerived;
+
+class SlabSameSize : public SubclassDerived {
+ public:
+  explicit SlabSameSize(int _value) : SubclassDerived(_value) {}
+  int value() const override { return -SubclassDerived::value(); }
+};
+
+class SlabBigger : public SubclassDerived {
+ public:
+  explicit SlabBigger(int _value) : SubclassDerived(_value), extra_{} {}
+
+ private:
+  double extra_[4];
+};
+
+class SlabOverAligned : public SubclassDerived {
+ public:
+  explicit SlabOverAligned(int _value) : SubclassDerived(_value), extra_{} {}
+
+ private:
+  alignas(128) char extra_[8];
+};
+
+class SlabOwnSlab : public SubclassDerived,
+                    public factory::SlabAllocated<SlabOwnSlab> {
+ public:
+  using factory::SlabAllocated<SlabOwnSlab>::operator new;
+  using factory::SlabAllocated<SlabOwnSlab>::operator delete;
+
+  explicit SlabOwnSlab(int _value) : SubclassDerived(_value) {}
+};
+
+class alignas(64) SlabAligned : public SlabBase,
+                                public factory::SlabAllocated<SlabAligned> {
+ public:
+  int value() const override { return 0; }
+};
+
+typedef factory::ObjectFactory<SlabBase, int> SlabFactory;
+
+}  // namespace
+
+registerWithObjectFactory("slab_derived", SlabBase, FactoryDerived, int);
+
+TEST(TypeSlab, forEach) {
+  typedef factory::TypeSlab<FactoryDerived> DerivedSlab;
+  const std::size_t kCount = 3 * DerivedSlab::kSlabObjects;
+
+  std::vector<SlabBase*> objects;
+  for (std::size_t idx = 0; idx < kCount; idx++) {
+    objects.push_back(
+        SlabFactory::create("slab_derived", static_cast<int>(idx)));
+  }
+  ASSERT_EQ(DerivedSlab::size(), kCount);
+
+  // Deletes every odd object, remembering the last freed address.
+  std::uintptr_t last_freed = 0;
+  for (std::size_t idx = 1; idx < kCount; idx += 2) {
+    last_freed = reinterpret_cast<std::uintptr_t>(
+        static_cast<FactoryDerived*>(objects.at(idx)));
+    delete objects.at(idx);
+    objects.at(idx) = nullptr;
+  }
+  ASSERT_EQ(DerivedSlab::size(), kCount / 2);
+
+  // Visits the remaining objects in memory order.
+  std::vector<int> values;
+  std::uintptr_t prev = 0;
+  DerivedSlab::forEach([&](FactoryDerived& _object) {
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(&_object);
+    EXPECT_LT(prev, addr);
+    prev = addr;
+    values.push_back(_object.value());
+  });
+  std::sort(values.begin(), values.end());
+  ASSERT_EQ(values.size(), kCount / 2);
+  for (std::size_t idx = 0; idx < kCount / 2; idx++) {
+    ASSERT_EQ(values.at(idx), static_cast<int>(idx * 2));
+  }
+
+  // Reuses the most recently freed slot rather than growing.
+  SlabBase* reused = SlabFactory::create("slab_derived", -1);
+  ASSERT_EQ(
+      reinterpret_cast<std::uintptr_t>(static_cast<FactoryDerived*>(reused)),
+      last_freed);
+  ASSERT_EQ(DerivedSlab::size(), kCount / 2 + 1);
+  delete reused;
+
+  for (SlabBase* object : objects) {
+    delete object;
+  }
+  ASSERT_EQ(DerivedSlab::size(), 0u);
+}
+
+TEST(TypeSlab, subclasses) {
+  typedef factory::TypeSlab<SubclassDerived> DerivedSlab;
+  ASSERT_EQ(sizeof(SlabSameSize), sizeof(SubclassDerived));
+  ASSERT_GT(sizeof(SlabBigger), sizeof(SubclassDerived));
+
+  // Only the same-size subclass shares the slab and is visited.
+  SlabBase* same = new SlabSameSize(5);
+  SlabBase* bigger = new SlabBigger(7);
+  SlabBase* own = new SlabOwnSlab(9);
+  std::vector<SlabOverAligned*> aligned;
+  for (int idx = 0; idx < 16; idx++) {
+    aligned.push_back(new SlabOverAligned(idx));
+  }
+  EXPECT_EQ(DerivedSlab::size(), 1u);
+  EXPECT_EQ(factory::TypeSlab<SlabOwnSlab>::size(), 1u);
+
+  std::vector<int> values;
+  DerivedSlab::forEach(
+      [&](SubclassDerived& _object) { values.push_back(_object.value()); });
+  EXPECT_EQ(values, std::vector<int>({-5}));
+
+  // Over-aligned subclasses get correctly aligned heap storage.
+  for (SlabOverAligned* object : aligned) {
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(object) % 128, 0u);
+    delete object;
+  }
+  delete same;
+  delete bigger;
+  delete own;
+  EXPECT_EQ(DerivedSlab::size(), 0u);
+  EXPECT_EQ(factory::TypeSlab<SlabOwnSlab>::size(), 0u);
+}
+
+TEST(TypeSlab, overAligned) {
+  std::vector<SlabAligned*> objects;
+  for (int idx = 0; idx < 16; idx++) {
+    objects.push_back(new SlabAligned());
+  }
+  EXPECT_EQ(factory::TypeSlab<SlabAligned>::size(), objects.size());
+  for (SlabAligned* object : objects) {
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(object) % 64, 0u);
+    delete object;
+  }
+  EXPECT_EQ(factory::TypeSlab<SlabAligned>::size(), 0u);
+}
+
+TEST(TypeSlab, placementNew) {
+  alignas(PlacementDerived) unsigned char buffer[sizeof(PlacementDerived)];
+  PlacementDerived* object = new (buffer) PlacementDerived(3);
+  EXPECT_EQ(static_cast<void*>(object), static_cast<void*>(buffer));
+  EXPECT_EQ(object->value(), 3);
+  EXPECT_EQ(factory::TypeSlab<PlacementDerived>::size(), 0u);
+  object->~PlacementDerived();
+}
+
+TEST(TypeSlab, threads) {
+  typedef factory::TypeSlab<ThreadDerived> DerivedSlab;
+  const std::size_t kThreads = 4;
+  const std::size_t kCount = 2 * DerivedSlab::kSlabObjects;
+
+  std::vector<std::vector<SlabBase*>> objects(kThreads);
+  std::vector<std::thread> threads;
+  for (std::size_t thread = 0; thread < kThreads; thread++) {
+    threads.emplace_back([&, thread]() {
+      for (std::size_t idx = 0; idx < kCount; idx++) {
+        objects.at(thread).push_back(
+            new ThreadDerived(static_cast<int>(idx)));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(DerivedSlab::size(), kThreads * kCount);
+
+  // Slabs allocated from different threads are still walked by address.
+  std::size_t visited = 0;
+  std::uintptr_t prev = 0;
+  DerivedSlab::forEach([&](ThreadDerived& _object) {
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(&_object);
+    EXPECT_LT(prev, addr);
+    prev = addr;
+    visited++;
+  });
+  EXPECT_EQ(visited, kThreads * kCount);
+
+  threads.clear();
+  for (std::size_t thread = 0; thread < kThreads; thread++) {
+    threads.emplace_back([&, thread]() {
+      for (SlabBase* object : objects.at(thread)) {
+        delete object;
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(DerivedSlab::size(), 0u);
+}